@@ -0,0 +1,66 @@
+#pragma once
+
+#include <kernel/types.h>
+#include <kernel/vfs.h>
+#include <kernel/list.h>
+
+/**
+ * Directory entry cache.
+ *
+ * kopen() consults this before calling finddir_fs() for each path
+ * component, but only in directories whose node has FS_DCACHE set.
+ * A driver sets that flag on the nodes it returns only if:
+ * - every name it adds or removes goes through create, mkdir,
+ *   symlink or unlink, and
+ * - inode numbers are unique and stable per device.
+ * Synthetic filesystems such as procfs, whose names come and go by
+ * themselves or reuse inode numbers, leave it clear and are never
+ * cached.
+ *
+ * Entries are keyed on the parent directory's (device, inode) pair,
+ * since finddir hands back a fresh fs_node_t on every call and node
+ * pointers are not stable. A hit returns a copy of the cached node,
+ * just as finddir would have. Entries with a NULL node are negative:
+ * they record that the name does not exist, so repeated stats of
+ * missing paths skip the filesystem too.
+ *
+ * create, mkdir, symlink and unlink invalidate the affected name in
+ * their parent. A positive entry holds a snapshot of the node's
+ * metadata, so chmod_fs, chown_fs, truncate_fs and write_fs on an
+ * FS_DCACHE node drop every entry for it through
+ * dcache_invalidate_node(), found by the node's own (device, inode)
+ * on a second hash chain. Unmounting drops every entry for that
+ * device. The cache holds at most DCACHE_MAX_ENTRIES, evicting least
+ * recently used.
+ *
+ * dcache_lookup() returns 1 on a hit, with *out set to the copy or to
+ * NULL for a negative entry, and 0 on a miss.
+ */
+#define DCACHE_MAX_ENTRIES 4096
+
+struct dentry {
+	void * device;
+	uint64_t parent_inode;
+	char * name;
+	fs_node_t * node;     /* NULL for a negative entry */
+	struct dentry * next; /* Hash chain on (device, parent_inode, name) */
+	struct dentry * node_next; /* Hash chain on (device, node->inode), positive entries only */
+	node_t lru;
+};
+
+struct dcache_stats {
+	uint64_t hits;
+	uint64_t negative_hits;
+	uint64_t misses;
+	uint64_t invalidations;
+	uint64_t evictions;
+	size_t entries;
+};
+
+extern void dcache_install(void);
+extern int dcache_lookup(fs_node_t * parent, const char * name, fs_node_t ** out);
+extern void dcache_insert(fs_node_t * parent, const char * name, fs_node_t * node);
+extern void dcache_invalidate(fs_node_t * parent, const char * name);
+extern void dcache_invalidate_node(fs_node_t * node);
+extern void dcache_invalidate_device(void * device);
+extern struct dcache_stats dcache_stats;
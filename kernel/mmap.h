@@ -0,0 +1,60 @@
+#pragma once
+
+#include <kernel/types.h>
+#include <kernel/vfs.h>
+#include <kernel/list.h>
+#include <sys/mman.h>
+
+/**
+ * A contiguous range of a process's address space with uniform
+ * protection and backing. Pages are not populated when an area is
+ * created; the page fault handler finds the area covering the
+ * faulting address and fills in the page, zeroed for anonymous
+ * areas or read from node at offset for file-backed ones. Shared
+ * file mappings are written back on msync and munmap.
+ *
+ * Every user mapping is an area, not just mmap results: exec adds the
+ * ELF load segments, heap and user stack; shm_obtain and device
+ * mappings add theirs. mmap_validate(), and through it copy_from_user
+ * and friends, therefore accept exactly the addresses that are mapped.
+ *
+ * Areas belong to the address space, not to a process: they are
+ * kept in the areas array of proc->thread.page_directory, shared by
+ * every thread and vfork child using that directory. The array is
+ * sorted by start, so mmap_find() and mmap_validate() check last_area
+ * first and then binary search, rather than walking every mapping.
+ * Mapping and unmapping shift the array under the directory's
+ * area_lock and reset last_area. mmap_clone() copies the areas into
+ * a forked child's new directory.
+ */
+#define VM_AREA_ANON   0 /* Anonymous mmap, heap and user stack */
+#define VM_AREA_FILE   1 /* File-backed mmap */
+#define VM_AREA_IMAGE  2 /* ELF load segment, registered by exec */
+#define VM_AREA_SHM    3 /* SHM chunk, registered by shm_obtain and removed by shm_release */
+#define VM_AREA_DEVICE 4 /* Device memory mapped into USER_DEVICE_MAP */
+
+typedef struct vm_area {
+	uintptr_t start;   /* Page aligned */
+	uintptr_t end;     /* Page aligned, exclusive */
+	int type;          /* VM_AREA_* */
+	int prot;          /* PROT_* */
+	int flags;         /* MAP_* */
+	int advice;        /* MADV_* */
+	fs_node_t * node;  /* Backing file, or NULL for anonymous memory */
+	off_t offset;      /* Offset into node of start */
+} vm_area_t;
+
+struct process;
+
+extern vm_area_t * mmap_find(struct process * proc, uintptr_t addr);
+extern int mmap_validate(struct process * proc, uintptr_t addr, size_t size, int flags);
+extern vm_area_t * mmap_add_area(struct process * proc, uintptr_t start, uintptr_t end, int type, int prot);
+extern int mmap_remove_area(struct process * proc, uintptr_t start, uintptr_t end);
+extern uintptr_t mmap_map(struct process * proc, uintptr_t addr, size_t length, int prot, int flags, fs_node_t * node, off_t offset);
+extern int mmap_unmap(struct process * proc, uintptr_t addr, size_t length);
+extern int mmap_protect(struct process * proc, uintptr_t addr, size_t length, int prot);
+extern int mmap_advise(struct process * proc, uintptr_t addr, size_t length, int advice);
+extern int mmap_sync(struct process * proc, uintptr_t addr, size_t length, int flags);
+extern int mmap_handle_fault(struct process * proc, uintptr_t addr, int write);
+extern void mmap_clone(struct process * to, struct process * from);
+extern void mmap_release_all(struct process * proc);
@@ -14,6 +14,7 @@
 #define USER_SHM_LOW      0x0000400100000000UL
 #define USER_SHM_HIGH     0x0000500000000000UL
 #define USER_DEVICE_MAP   0x0000400000000000UL
+#define USER_MMAP_HIGH    0x0000300000000000UL /* mmap areas without MAP_FIXED grow down from here */
 
 #define MMU_FLAG_KERNEL       0x01
 #define MMU_FLAG_WRITABLE     0x02
@@ -22,36 +23,115 @@
 #define MMU_FLAG_SPEC         0x10
 #define MMU_FLAG_WC           (MMU_FLAG_NOCACHE | MMU_FLAG_WRITETHROUGH | MMU_FLAG_SPEC)
 #define MMU_FLAG_NOEXECUTE    0x20
+#define MMU_FLAG_ZERO         0x40 /* Map the shared zero frame read-only; a real frame is allocated on first write */
 
 #define MMU_GET_MAKE 0x01
 
+/**
+ * Large page sizes. Mapped with the size bit set in a PDPT (1 GiB,
+ * where the CPU supports it) or page directory (2 MiB) entry on
+ * x86-64, or as level 1/2 block descriptors on aarch64.
+ */
+#define MMU_PAGE_SIZE_4K 0x1000UL
+#define MMU_PAGE_SIZE_2M 0x200000UL
+#define MMU_PAGE_SIZE_1G 0x40000000UL
+
+
+/**
+ * Pending invalidations, collected while changing many entries and
+ * then flushed once. Past MMU_FLUSH_FULL_THRESHOLD pages it is
+ * cheaper to drop the whole address space from the TLB than to
+ * invalidate page by page.
+ */
+struct mmu_flush_batch {
+	uintptr_t start;
+	uintptr_t end;
+	size_t pages;
+};
+#define MMU_FLUSH_FULL_THRESHOLD 32
 
 #define MMU_PTR_NULL  1
 #define MMU_PTR_WRITE 2
 
+/**
+ * Physical frames are managed by a buddy allocator with free lists
+ * for blocks of 2^0 through 2^(MMU_BUDDY_ORDERS-1) frames, so both
+ * single frames and contiguous runs are found without scanning.
+ * Single-frame allocations are served first from a per-core cache
+ * of up to MMU_FRAME_CACHE_SIZE frames, refilled and drained in
+ * batches of MMU_FRAME_CACHE_BATCH under the buddy lock.
+ *
+ * mmu_allocate_n_frames() takes a block of the smallest order that
+ * holds n frames and immediately frees the unused tail back to the
+ * buddy lists as smaller blocks, so only n frames stay allocated.
+ *
+ * One bit per frame is still kept to record which frames are in use,
+ * for mmu_frame_test() and for the buddy lists' coalescing checks,
+ * but it is never scanned to find free memory. mmu_frame_set() takes
+ * a specific frame (firmware-reserved ranges, MMIO) out of the buddy
+ * lists; mmu_frame_clear() and mmu_frame_release() return one.
+ */
+#define MMU_BUDDY_ORDERS      11
+#define MMU_FRAME_CACHE_SIZE  64
+#define MMU_FRAME_CACHE_BATCH 32
+
+/**
+ * Frames zeroed ahead of time by the idle task. Write faults on
+ * zero-page mappings take from this pool first and only clear a
+ * frame themselves when it is empty.
+ */
+#define MMU_ZERO_POOL_SIZE    256
+
 void mmu_frame_set(uintptr_t frame_addr);
 void mmu_frame_clear(uintptr_t frame_addr);
 void mmu_frame_release(uintptr_t frame_addr);
 int mmu_frame_test(uintptr_t frame_addr);
-uintptr_t mmu_first_n_frames(int n);
-uintptr_t mmu_first_frame(void);
 void mmu_frame_allocate(union PML * page, unsigned int flags);
 void mmu_frame_map_address(union PML * page, unsigned int flags, uintptr_t physAddr);
+void mmu_frame_map_zero(union PML * page, unsigned int flags);
+int mmu_frame_is_zero(union PML * page);
+uintptr_t mmu_allocate_zeroed_frame(void);
+void mmu_zero_pool_fill(void);
+size_t mmu_zero_pool_count(void);
 void mmu_frame_free(union PML * page);
 uintptr_t mmu_map_to_physical(union PML * root, uintptr_t virtAddr);
 union PML * mmu_get_page(uintptr_t virtAddr, int flags);
+int mmu_map_large(union PML * root, uintptr_t virtAddr, uintptr_t physAddr, size_t size, unsigned int flags);
+int mmu_supports_page_size(size_t size);
 void mmu_set_directory(union PML * new_pml);
 void mmu_free(union PML * from);
 union PML * mmu_clone(union PML * from);
 void mmu_invalidate(uintptr_t addr);
+void mmu_invalidate_range(uintptr_t start, size_t length);
+void mmu_flush_batch_add(struct mmu_flush_batch * batch, uintptr_t addr);
 uintptr_t mmu_allocate_a_frame(void);
 uintptr_t mmu_allocate_n_frames(int n);
+uintptr_t mmu_allocate_order(int order);
+void mmu_free_order(uintptr_t frame_addr, int order);
+size_t mmu_free_blocks(int order);
 union PML * mmu_get_kernel_directory(void);
 void * mmu_map_from_physical(uintptr_t frameaddress);
 void * mmu_map_mmio_region(uintptr_t physical_address, size_t size);
 void * mmu_map_module(size_t size);
 void mmu_unmap_module(uintptr_t base_address, size_t size);
 
+/**
+ * System-wide breakdown of physical memory, in kilobytes, for
+ * /proc/meminfo. Each counter is maintained where frames change
+ * hands rather than computed on demand.
+ */
+struct mmu_memory_stats {
+	size_t total;
+	size_t free;
+	size_t kernel_heap;
+	size_t slab;
+	size_t page_cache;
+	size_t shm;
+	size_t user;
+};
+
+void mmu_memory_stats(struct mmu_memory_stats * out);
+
 size_t mmu_count_user(union PML * from);
 size_t mmu_count_shm(union PML * from);
 size_t mmu_total_memory(void);
@@ -9,11 +9,22 @@
 #include <kernel/spinlock.h>
 #include <kernel/process.h>
 
+/**
+ * Acquisition is adaptive: while the owner is running on another
+ * core (PROC_FLAG_RUNNING), it is likely to release soon, so a
+ * contender spins for up to MUTEX_SPIN_LIMIT iterations before
+ * sleeping on waiters. On release with sleepers present, ownership
+ * is handed directly to the first waiter and only that one is woken,
+ * so waiters do not stampede for the lock.
+ */
+#define MUTEX_SPIN_LIMIT 1000
+
 typedef struct {
 	spin_lock_t inner_lock;
 	volatile int status;
-	process_t * owner;
+	process_t * volatile owner;
 	list_t * waiters;
+	process_t * volatile handoff; /* Waiter the lock was passed to on release */
 } sched_mutex_t;
 
 extern sched_mutex_t * mutex_init(const char * name);
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <kernel/types.h>
+#include <kernel/vfs.h>
+#include <kernel/list.h>
+#include <kernel/hashmap.h>
+#include <kernel/spinlock.h>
+
+/**
+ * Page cache.
+ *
+ * read_fs() and write_fs() on nodes flagged FS_CACHEABLE go through
+ * here instead of straight to the driver. Each cached file has one
+ * pagecache_mapping, found by the node's (device, inode). It holds
+ * its own reference to a clone of the node, so the flusher and
+ * reclaim can still call the driver's write after every opener has
+ * closed the file. Its pages are indexed by page-sized offset within
+ * the mapping, so syncing or truncating a file only visits that
+ * file's pages. A miss reads the page, plus up to PAGECACHE_READAHEAD
+ * more when it follows last_index, through the node's read callback.
+ * A mapping, and its node reference, is dropped once it has no pages.
+ *
+ * Until write-back, the mapping's size is the file's authoritative
+ * length: pagecache_write() raises it when writing past the end and
+ * pagecache_truncate() sets it. read_fs() clips reads against it,
+ * and get_size and stat report it through pagecache_size(), so other
+ * openers see data that has not reached the driver yet.
+ * pagecache_size() returns 1 and sets *size when the node has a
+ * mapping, and 0 when it does not and node->length is current.
+ *
+ * Writes only dirty cached pages; the flusher thread writes them
+ * back after PAGECACHE_WRITEBACK_DELAY seconds, and IOCTLSYNC and
+ * sync() flush immediately. File-backed mmap areas map cached
+ * frames directly, so readers and mappers share one copy. Clean
+ * pages are released to the reclaim framework under pressure.
+ */
+#define PAGECACHE_READAHEAD       8
+#define PAGECACHE_WRITEBACK_DELAY 5
+
+#define PAGECACHE_UPTODATE 0x01
+#define PAGECACHE_DIRTY    0x02
+#define PAGECACHE_LOCKED   0x04
+
+struct pagecache_mapping;
+
+struct cached_page {
+	struct pagecache_mapping * mapping;
+	uint64_t index;     /* Offset in the file, in pages */
+	uintptr_t frame;
+	volatile int flags; /* PAGECACHE_* */
+	uint64_t dirtied;   /* Tick when first dirtied, for the flusher */
+	node_t lru;
+};
+
+struct pagecache_mapping {
+	void * device;
+	uint64_t inode;
+	fs_node_t * node;     /* Referenced clone used for read-in and write-back */
+	spin_lock_t lock;
+	hashmap_t * pages;    /* Page index -> struct cached_page */
+	size_t dirty_pages;
+	uint64_t last_index;  /* Last page read, for sequential readahead detection */
+	uint64_t size;        /* File length including unwritten-back data; replaces node->length */
+	struct pagecache_mapping * next; /* Hash chain on (device, inode) */
+	node_t dirty_node;    /* On the flusher's list while dirty_pages is nonzero */
+};
+
+extern void pagecache_install(void);
+extern ssize_t pagecache_read(fs_node_t * node, off_t offset, size_t size, uint8_t * buffer);
+extern ssize_t pagecache_write(fs_node_t * node, off_t offset, size_t size, uint8_t * buffer);
+extern uintptr_t pagecache_get_frame(fs_node_t * node, off_t offset);
+extern int pagecache_size(fs_node_t * node, uint64_t * size);
+extern int pagecache_sync(fs_node_t * node);
+extern void pagecache_sync_all(void);
+extern void pagecache_truncate(fs_node_t * node, off_t length);
@@ -5,29 +5,59 @@
 #include <kernel/vfs.h>
 #include <kernel/tree.h>
 #include <kernel/list.h>
+#include <kernel/hashmap.h>
 #include <kernel/spinlock.h>
 #include <sys/types.h>
 #include <sys/time.h>
 #include <sys/signal_defs.h>
 #include <sys/signal.h>
 
-#ifdef __x86_64__
-#include <kernel/arch/x86_64/pml.h>
-#endif
-
-#ifdef __aarch64__
-#include <kernel/arch/aarch64/pml.h>
-#endif
+#include <kernel/mmu.h>
 
 
 #define PROC_REUSE_FDS 0x0001
 #define KERNEL_STACK_SIZE 0x9000
 #define USER_ROOT_UID 0
 
+/**
+ * Each directory is tagged with an address space identifier (PCID on
+ * x86-64, ASID on aarch64) so that switching to it does not flush the
+ * TLB. Identifiers are handed out from a global counter; when it wraps,
+ * the generation is bumped and every core flushes once, and directories
+ * from an older generation are given a new identifier when next loaded.
+ */
 typedef struct {
 	intptr_t refcount;
 	union PML * directory;
 	spin_lock_t lock;
+	volatile uint64_t active_cpus; /* Cores that have this directory loaded */
+	uint16_t asid;
+	uint64_t asid_generation;
+
+	/**
+	 * Page counts, updated as this directory's entries are mapped and
+	 * unmapped. Each only depends on this directory's own entries, so
+	 * none of them change when another process breaks copy-on-write
+	 * or exits. shared_pages is therefore an upper bound: a page stays
+	 * counted while its copy-on-write mark is set, even if the other
+	 * copies have gone away.
+	 */
+	volatile size_t rss_pages;    /* Present user pages, including shared and SHM */
+	volatile size_t shared_pages; /* Present pages marked copy-on-write here, or in MAP_SHARED areas */
+	volatile size_t shm_pages;    /* Pages in the SHM region */
+
+	/**
+	 * VM areas describing this address space (see kernel/mmap.h).
+	 * They live here rather than in image_t because clone() threads
+	 * and vfork children share the directory, and must see each
+	 * other's mappings. area_lock protects all of the fields below.
+	 */
+	spin_lock_t area_lock;
+	struct vm_area ** areas;             /* Sorted by start, non-overlapping; includes the heap and user stack */
+	size_t area_count;
+	size_t area_capacity;
+	struct vm_area * volatile last_area; /* Most recent mmap_find() hit, checked before searching */
+	uintptr_t mmap_base; /* Lowest address handed out below USER_MMAP_HIGH */
 } page_directory_t;
 
 typedef struct {
@@ -49,9 +79,29 @@ typedef struct {
 	 */
 } kthread_context_t;
 
+/**
+ * x86-64: XSAVE area with room for x87/SSE (512), the XSAVE
+ * header (64), and AVX upper halves (256). aarch64: q0-q31.
+ *
+ * Two requirements follow on x86-64:
+ * - XCR0 must be limited to FP_XCR0_MASK. Enabling AVX-512 or
+ *   other components would make XSAVE write past fp_regs.
+ * - XSAVE faults on an area that is not 64-byte aligned. The
+ *   attribute below only aligns fp_regs within the structure, so
+ *   process_t must come from process_cache, which is created with
+ *   PROCESS_ALIGN alignment, and never from plain malloc().
+ */
+#define PROCESS_ALIGN 64
+#ifdef __x86_64__
+#define FP_REGS_SIZE 832
+#define FP_XCR0_MASK 0x7 /* x87 | SSE | AVX */
+#else
+#define FP_REGS_SIZE 512
+#endif
+
 typedef struct thread {
 	kthread_context_t context;
-	uint8_t fp_regs[512] __attribute__((aligned(16)));
+	uint8_t fp_regs[FP_REGS_SIZE] __attribute__((aligned(PROCESS_ALIGN)));
 	page_directory_t * page_directory;
 } thread_t;
 
@@ -64,14 +114,45 @@ typedef struct image {
 	spin_lock_t lock;
 } image_t;
 
+/**
+ * One open descriptor's state. Entries come from fd_entry_cache,
+ * whose objects are 64-byte aligned, so each occupies a cache line of
+ * its own and offset updates on neighbouring descriptors don't contend.
+ */
+typedef struct file_descriptor {
+	fs_node_t * node; /* NULL while the slot is closed */
+	uint64_t offset;
+	int mode;
+} __attribute__((aligned(64))) fd_entry_t;
+
+/**
+ * Slots are found through a bitmap of in-use descriptors, so
+ * process_append_fd() takes the lowest free one with a find-first-zero
+ * per 64 descriptors rather than scanning entries.
+ *
+ * entries holds pointers. Every slot below length has an fd_entry_t,
+ * which stays attached to that slot until the table is destroyed;
+ * closing a descriptor clears its node but keeps the entry. Growing
+ * the table therefore only copies pointers, and an offset update or
+ * close made through an old array still lands in the same entry.
+ *
+ * Only writers take the lock. When the table grows, the new array
+ * is filled in and published with a release store to entries, and
+ * only then is length raised with a second release store. Readers
+ * (FD_INRANGE and friends) load length and then entries with acquire
+ * loads, so a length they have seen is never paired with an older,
+ * smaller array. Old arrays are parked on retired until the table
+ * is destroyed, so readers never see freed memory. Tables never
+ * shrink.
+ */
 typedef struct file_descriptors {
-	fs_node_t ** entries;
-	uint64_t * offsets;
-	int * modes;
-	size_t length;
+	fd_entry_t ** volatile entries;
+	uint64_t * bitmap;
+	volatile size_t length;
 	size_t capacity;
 	size_t refs;
 	spin_lock_t lock;
+	list_t * retired;
 } fd_table_t;
 
 struct signal_config {
@@ -90,6 +171,9 @@ struct signal_config {
 #define PROC_FLAG_TRACE_SYSCALLS     0x40
 #define PROC_FLAG_TRACE_SIGNALS      0x80
 
+#define SCHED_LATENCY_BUCKETS 24
+#define SCHED_DEPTH_SAMPLES   64
+
 typedef struct process {
 	pid_t id;    /* PID */
 	pid_t group; /* thread group */
@@ -125,6 +209,8 @@ typedef struct process {
 	node_t sleep_node;
 	node_t * timed_sleep_node;
 	node_t * timeout_node;
+	node_t job_node;     /* Membership in this process's job in process_job_map */
+	node_t session_node; /* Membership in this process's session in process_session_map */
 
 	struct timeval start;
 	int awoken_index;
@@ -159,6 +245,24 @@ typedef struct process {
 
 	/* Syscall restarting */
 	long interrupted_system_call;
+
+	/* Scheduling */
+	int last_cpu;       /* core this process last ran on, preferred when it is made ready again */
+	uint64_t affinity;  /* bitmap of cores this process may run on; inherited by fork and clone */
+	int sched_policy;   /* SCHED_OTHER or SCHED_FIFO */
+	int sched_priority; /* SCHED_FIFO priority, 1 (lowest) to 99 */
+	int nice;           /* -20 to 19, selects weight from sched_nice_weight */
+	uint64_t vruntime;  /* time_total scaled by weight; SCHED_OTHER runs the lowest first */
+
+	/* vfork: parent suspended until this process calls exec or exits */
+	struct process * vfork_parent;
+
+	/* Scheduler statistics, reported in /proc/[pid]/sched */
+	uint64_t time_ready;            /* arch_perf_timer() stamp of when make_process_ready() last queued this process */
+	uint64_t switches_voluntary;    /* gave up the core by sleeping or yielding */
+	uint64_t switches_involuntary;  /* preempted while still runnable */
+	uint64_t migrations;            /* started running on a different core than last_cpu */
+	uint32_t wakeup_latency[SCHED_LATENCY_BUCKETS]; /* ready-to-running delay, bucket n counts < 2^n microseconds */
 } process_t;
 
 typedef struct {
@@ -166,8 +270,37 @@ typedef struct {
 	uint64_t end_subtick;
 	process_t * process;
 	int is_fswait;
+	node_t wheel_node; /* Link into a timer wheel slot; lets cancellation skip the search */
 } sleeper_t;
 
+/**
+ * Timed sleepers are kept in a hierarchical timer wheel rather than
+ * a sorted list. Level 0 holds one slot per TIMER_WHEEL_RESOLUTION
+ * subticks; each following level covers TIMER_WHEEL_SLOTS times the
+ * span of the one before. Insertion and cancellation are O(1), and
+ * a tick only visits the current level 0 slot, cascading a slot of
+ * the next level down whenever level 0 wraps around. Deadlines
+ * beyond the top level are parked in its last slot and re-filed
+ * when it cascades.
+ */
+#define TIMER_WHEEL_RESOLUTION 1000 /* subticks per level 0 slot */
+#define TIMER_WHEEL_BITS       6
+#define TIMER_WHEEL_SLOTS      (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS     4
+
+struct timer_wheel {
+	list_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	uint64_t current; /* Slot time the wheel has been advanced to */
+	spin_lock_t lock;
+
+	/* Counters for /proc/timers */
+	size_t   pending;
+	uint64_t inserted;
+	uint64_t cancelled;
+	uint64_t expired;
+	uint64_t cascaded;
+};
+
 struct ProcessorLocal {
 	/**
 	 * @brief The running process on this core.
@@ -216,7 +349,74 @@ struct ProcessorLocal {
 	uintptr_t sp_el1;
 	uint64_t  midr;
 #endif
-};
+
+	/**
+	 * @brief Ready queue for this core.
+	 *
+	 * Processes made ready are queued, in order of vruntime, on
+	 * the core they last ran on, so the common case of switching
+	 * tasks only touches this core's queue and lock. When the
+	 * queue is empty, the scheduler tries to steal from the busiest
+	 * other core before falling back to the idle task.
+	 *
+	 * These live after the arch-specific fields, whose offsets
+	 * are referenced from assembly. Other cores take the lock and
+	 * poll the length when queuing or stealing work, so the queue
+	 * gets a cache line of its own, apart from the fields this core
+	 * touches on every switch; the core-local fields that follow
+	 * start on a fresh line.
+	 */
+	spin_lock_t run_queue_lock __attribute__((aligned(64)));
+	volatile size_t run_queue_length;
+	list_t * run_queue;
+	list_t * rt_queue;     /* SCHED_FIFO processes, ahead of run_queue; shares run_queue_lock */
+	uint64_t min_vruntime; /* Floor for processes joining run_queue, so sleepers can't bank credit */
+
+	/**
+	 * @brief Run queue depth history for /proc/schedstat.
+	 *
+	 * run_queue_length is sampled into this ring on every tick;
+	 * run_queue_depth_index is the next slot to be written.
+	 */
+	uint16_t run_queue_depth[SCHED_DEPTH_SAMPLES] __attribute__((aligned(64)));
+	unsigned int run_queue_depth_index;
+
+	/**
+	 * @brief Process whose floating-point state is live in this core's registers.
+	 *
+	 * x86-64 saves eagerly on every switch with XSAVEOPT, which skips
+	 * components that are unmodified since the last XRSTOR, and restores
+	 * with XRSTOR unless the incoming process is already fpu_owner. It
+	 * never leaves another process's state in the registers behind a
+	 * CR0.TS trap, as that is open to LazyFP (CVE-2018-3665).
+	 *
+	 * aarch64 switches lazily: it only disables FP access
+	 * (CPACR_EL1.FPEN), and the first FP instruction traps into
+	 * arch_floating_trap(), which saves fpu_owner's state, restores
+	 * the current process's, and claims the registers.
+	 */
+	volatile process_t * fpu_owner;
+
+	/**
+	 * @brief Free frames held back for this core's single-page allocations.
+	 *
+	 * Only touched by this core, with interrupts disabled.
+	 */
+	uintptr_t frame_cache[MMU_FRAME_CACHE_SIZE];
+	size_t frame_cache_count;
+
+	/**
+	 * @brief One-shot deadline armed while the tick is stopped.
+	 *
+	 * Both are zero while the periodic tick is running.
+	 */
+	uint64_t timer_deadline_tick;
+	uint64_t timer_deadline_subtick;
+} __attribute__((aligned(64))); /* processor_local_data[] entries never share a cache line */
+
+struct slab_cache;
+extern struct slab_cache * process_cache;  /* All process_t allocations; PROCESS_ALIGN-aligned */
+extern struct slab_cache * fd_entry_cache; /* All fd_entry_t allocations; 64-byte aligned */
 
 extern struct ProcessorLocal processor_local_data[];
 extern int processor_count;
@@ -237,16 +437,24 @@ extern unsigned long process_append_fd(process_t * proc, fs_node_t * node);
 extern long process_move_fd(process_t * proc, long src, long dest);
 extern void initialize_process_tree(void);
 extern process_t * process_from_pid(pid_t pid);
+extern void process_set_job(process_t * proc, pid_t job);
+extern void process_set_session(process_t * proc, pid_t session);
 
 extern void process_delete(process_t * proc);
 extern void make_process_ready(volatile process_t * proc);
 extern volatile process_t * next_ready_process(void);
+extern volatile process_t * steal_ready_process(void);
+extern int process_set_affinity(process_t * proc, uint64_t affinity);
+extern int process_set_nice(process_t * proc, int nice);
+extern const uint32_t sched_nice_weight[40]; /* nice -20..19; 1024 at nice 0 */
 extern int wakeup_queue(list_t * queue);
 extern int wakeup_queue_interrupted(list_t * queue);
 extern int sleep_on(list_t * queue);
 extern int sleep_on_unlocking(list_t * queue, spin_lock_t * release);
 extern int process_alert_node(process_t * process, void * value);
 extern void sleep_until(process_t * process, unsigned long seconds, unsigned long subseconds);
+extern void sleep_cancel(process_t * process);
+extern int sleep_next_deadline(unsigned long * seconds, unsigned long * subseconds);
 extern void switch_task(uint8_t reschedule);
 extern int process_wait_nodes(process_t * process,fs_node_t * nodes[], int timeout);
 extern process_t * process_get_parent(process_t * process);
@@ -260,6 +468,9 @@ extern void process_release_directory(page_directory_t * dir);
 extern process_t * spawn_worker_thread(void (*entrypoint)(void * argp), const char * name, void * argp);
 extern pid_t fork(void);
 extern pid_t clone(uintptr_t new_stack, uintptr_t thread_func, uintptr_t arg);
+extern pid_t vfork(void);
+extern pid_t spawn(const char * path, char *const argv[], char *const env[], const void * file_actions, const void * attr);
+extern void process_release_vfork(process_t * proc);
 extern int waitpid(int pid, int * status, int options);
 extern int exec(const char * path, int argc, char *const argv[], char *const env[], int interp_depth);
 extern void update_process_usage(uint64_t clock_ticks, uint64_t perf_scale);
@@ -267,8 +478,10 @@ extern void update_process_times_on_exit(void);
 
 extern tree_t * process_tree;  /* Parent->Children tree */
 extern list_t * process_list;  /* Flat storage */
-extern list_t * process_queue; /* Ready queue */
-extern list_t * sleep_queue;
+extern hashmap_t * process_pid_map;     /* PID -> process_t, kept in step with process_list */
+extern hashmap_t * process_job_map;     /* Job -> list_t of members, linked through job_node */
+extern hashmap_t * process_session_map; /* Session -> list_t of members, linked through session_node */
+extern struct timer_wheel sleep_wheel; /* Timed sleepers */
 
 extern void arch_enter_tasklet(void);
 extern __attribute__((noreturn)) void arch_resume_user(void);
@@ -276,10 +489,17 @@ extern __attribute__((noreturn)) void arch_restore_context(volatile thread_t * b
 extern __attribute__((returns_twice)) int arch_save_context(volatile thread_t * buf);
 extern void arch_restore_floating(process_t * proc);
 extern void arch_save_floating(process_t * proc);
+#ifdef __aarch64__
+extern void arch_disable_floating(void);
+extern void arch_floating_trap(void);
+#endif
 extern void arch_set_kernel_stack(uintptr_t);
 extern void arch_enter_user(uintptr_t entrypoint, int argc, char * argv[], char * envp[], uintptr_t stack);
 __attribute__((noreturn))
 extern void arch_enter_signal_handler(uintptr_t,int,struct regs*);
 extern void arch_wakeup_others(void);
+extern void arch_tlb_shootdown(uint64_t cpus, struct mmu_flush_batch * batch);
+extern void process_flush_tlb(page_directory_t * dir, struct mmu_flush_batch * batch);
+extern void process_set_directory(page_directory_t * dir);
 extern int arch_return_from_signal_handler(struct regs *r);
 
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <kernel/types.h>
+
+/**
+ * Memory reclaim.
+ *
+ * Subsystems holding memory they can give back (page cache, slab
+ * caches, icon and glyph caches, swappable tmpfs) register a
+ * shrinker. When free frames drop below reclaim_low_watermark, the
+ * frame allocator wakes the reclaim worker, which asks each shrinker
+ * in turn to free pages until reclaim_high_watermark is reached. If
+ * an allocation cannot wait for the worker, it calls reclaim_direct().
+ *
+ * The current pressure level can be read from /dev/mempressure as
+ * "none", "low" or "critical"; the node is fswait-able and becomes
+ * ready whenever the level changes.
+ */
+#define MEMORY_PRESSURE_NONE     0
+#define MEMORY_PRESSURE_LOW      1 /* Below the low watermark, background reclaim running */
+#define MEMORY_PRESSURE_CRITICAL 2 /* Allocations are failing or reclaiming directly */
+
+struct shrinker {
+	const char * name;
+	size_t (*count)(struct shrinker * self);                /* Pages that could be freed right now */
+	size_t (*scan)(struct shrinker * self, size_t target);  /* Try to free target pages, return how many were */
+	void * data;
+	struct shrinker * next;
+};
+
+extern size_t reclaim_low_watermark;  /* In frames */
+extern size_t reclaim_high_watermark; /* In frames */
+
+extern void register_shrinker(struct shrinker * shrinker);
+extern void unregister_shrinker(struct shrinker * shrinker);
+extern void reclaim_install(void);
+extern void reclaim_wakeup(void);
+extern size_t reclaim_direct(size_t pages);
+extern int memory_pressure_level(void);
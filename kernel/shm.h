@@ -9,12 +9,16 @@
 /* Types */
 struct shm_node;
 
+/* Chunks at least this big are backed by 2 MiB frames. */
+#define SHM_LARGE_CHUNK 0x200000
+
 typedef struct {
 	struct shm_node * parent;
 	volatile uint8_t lock;
 	ssize_t ref_count;
 	size_t num_frames;
 	uintptr_t *frames;
+	size_t frame_size; /* Size of each entry in frames: 4 KiB, or 2 MiB for large chunks */
 } shm_chunk_t;
 
 typedef struct shm_node {
@@ -36,4 +40,5 @@ extern int    shm_release(char * path);
 /* Other exposed functions */
 extern void shm_install(void);
 extern void shm_release_all(process_t * proc);
+extern size_t shm_count_proportional(process_t * proc);
 
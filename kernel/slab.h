@@ -0,0 +1,67 @@
+#pragma once
+
+#include <kernel/types.h>
+#include <kernel/spinlock.h>
+
+/**
+ * Object caches for fixed-size kernel allocations.
+ *
+ * Each cache carves page-sized slabs into objects of one size.
+ * Every core keeps two magazines of up to SLAB_MAGAZINE_SIZE free
+ * objects, a loaded one and the previous one. An allocation that
+ * finds loaded empty, or a free that finds it full, swaps the two
+ * before going to the cache, so alternating allocs and frees at
+ * that boundary stay core-local. Only when both are exhausted (or
+ * both full) is a magazine's worth of objects exchanged with the
+ * cache's slabs under its lock. If a constructor is given, it runs once when an
+ * object is first carved from a slab, not on every allocation, so
+ * objects must be returned to their constructed state before they
+ * are freed.
+ */
+#define SLAB_MAGAZINE_SIZE 32
+
+struct slab_magazine {
+	size_t count;
+	void * objects[SLAB_MAGAZINE_SIZE];
+};
+
+struct slab_cpu {
+	struct slab_magazine * loaded;
+	struct slab_magazine * previous;
+};
+
+typedef void (*slab_ctor_t)(void * object);
+
+typedef struct slab_cache {
+	const char * name;
+	size_t object_size;
+	size_t align;
+	slab_ctor_t ctor;
+
+	spin_lock_t lock;
+	void * partial;  /* Slabs with some objects free */
+	void * full;     /* Slabs with no objects free */
+	void * empty;    /* Slabs with every object free, released first under memory pressure */
+	struct slab_cpu * cpus; /* One per core, indexed by cpu_id */
+
+	/* Statistics for /proc/slabinfo */
+	size_t slabs;
+	size_t objects_in_use;
+	uint64_t allocations;
+	uint64_t frees;
+	uint64_t magazine_misses;
+
+	struct slab_cache * next;
+} slab_cache_t;
+
+extern slab_cache_t * slab_cache_create(const char * name, size_t object_size, size_t align, slab_ctor_t ctor);
+extern void slab_cache_destroy(slab_cache_t * cache);
+extern void * slab_alloc(slab_cache_t * cache);
+extern void slab_free(slab_cache_t * cache, void * object);
+extern size_t slab_cache_shrink(slab_cache_t * cache);
+extern slab_cache_t * slab_caches; /* All caches, for /proc/slabinfo */
+
+/* Caches for the kernel's most frequently allocated objects. */
+extern slab_cache_t * list_node_cache; /* node_t, used by list_insert() */
+extern slab_cache_t * fs_node_cache;   /* fs_node_t */
+extern slab_cache_t * sleeper_cache;   /* sleeper_t */
@@ -4,21 +4,59 @@
 #include <kernel/misc.h>
 #include <kernel/printf.h>
 
+/**
+ * Ticket lock: latch[0] is the ticket now being served and next is
+ * the ticket handed to the next core to arrive, so waiters acquire
+ * in FIFO order and only read the lock word while spinning. Both are
+ * unsigned so that they wrap around rather than overflow; the
+ * aarch64 implementation treats them the same way.
+ */
 typedef volatile struct {
-    volatile int latch[1];
+    volatile unsigned int latch[1];
+    volatile unsigned int next;
     int owner;
     const char * func;
+#ifdef SPINLOCK_STATS
+    uint64_t acquired; /* arch_perf_timer() stamp of the last acquisition */
+#endif
 } spin_lock_t;
-#define spin_init(lock) do { (lock).owner = 0; (lock).latch[0] = 0; (lock).func = NULL; } while (0)
+#define spin_init(lock) do { (lock).owner = 0; (lock).latch[0] = 0; (lock).next = 0; (lock).func = NULL; } while (0)
+
+#ifdef SPINLOCK_STATS
+/**
+ * Contention accounting, keyed by the acquiring function, and
+ * reported through /proc/lockstat. Recorded by the spin_lock and
+ * spin_unlock wrappers below on both architectures.
+ */
+extern void spin_lock_stats_acquired(const char * func, uint64_t spin_cycles);
+extern void spin_lock_stats_released(const char * func, uint64_t held_cycles);
+#define spin_stats_acquire(lock, acquire) do { uint64_t __start = arch_perf_timer(); acquire; \
+	(lock).acquired = arch_perf_timer(); spin_lock_stats_acquired(__func__, (lock).acquired - __start); } while (0)
+#define spin_stats_release(lock) spin_lock_stats_released((lock).func, arch_perf_timer() - (lock).acquired)
+#endif
 
 #ifdef __aarch64__
 extern void arch_spin_lock_acquire(const char * name, spin_lock_t * lock, const char * func);
 extern void arch_spin_lock_release(spin_lock_t * lock);
+#ifdef SPINLOCK_STATS
+#define spin_lock(lock) spin_stats_acquire(lock, arch_spin_lock_acquire(#lock, &lock, __func__))
+#define spin_unlock(lock) do { spin_stats_release(lock); arch_spin_lock_release(&lock); } while (0)
+#else
 #define spin_lock(lock) arch_spin_lock_acquire(#lock, &lock, __func__)
 #define spin_unlock(lock) arch_spin_lock_release(&lock)
+#endif
+#else
+#define spin_take_ticket(lock) do { unsigned int __ticket = __atomic_fetch_add(&(lock).next, 1, __ATOMIC_RELAXED); \
+	while (__atomic_load_n((lock).latch, __ATOMIC_ACQUIRE) != __ticket) asm volatile ("pause"); } while (0)
+#define spin_release_ticket(lock) \
+	__atomic_store_n((lock).latch, (lock).latch[0] + 1U, __ATOMIC_RELEASE)
+#ifdef SPINLOCK_STATS
+#define spin_lock(lock) do { spin_stats_acquire(lock, spin_take_ticket(lock)); (lock).owner = this_core->cpu_id+1; (lock).func = __func__; } while (0)
+#define spin_unlock(lock) do { spin_stats_release(lock); (lock).func = NULL; (lock).owner = -1; spin_release_ticket(lock); } while (0)
 #else
-#define spin_lock(lock) do { while (__sync_lock_test_and_set((lock).latch, 0x01)); (lock).owner = this_core->cpu_id+1; (lock).func = __func__; } while (0)
-#define spin_unlock(lock) do { (lock).func = NULL; (lock).owner = -1; __sync_lock_release((lock).latch); } while (0)
+#define spin_lock(lock) do { spin_take_ticket(lock); (lock).owner = this_core->cpu_id+1; (lock).func = __func__; } while (0)
+#define spin_unlock(lock) do { (lock).func = NULL; (lock).owner = -1; spin_release_ticket(lock); } while (0)
+#endif
 #endif
 
 #include <kernel/process.h>
@@ -2,16 +2,20 @@
 #include <kernel/types.h>
 #include <kernel/process.h>
 
+#define FD_LENGTH() \
+	__atomic_load_n(&this_core->current_process->fds->length, __ATOMIC_ACQUIRE)
+#define FD_ENTRIES() \
+	__atomic_load_n(&this_core->current_process->fds->entries, __ATOMIC_ACQUIRE)
 #define FD_INRANGE(FD) \
-	((FD) < (int)this_core->current_process->fds->length && (FD) >= 0)
+	((FD) < (int)FD_LENGTH() && (FD) >= 0)
 #define FD_ENTRY(FD) \
-	(this_core->current_process->fds->entries[(FD)])
+	(FD_ENTRIES()[(FD)]->node)
 #define FD_CHECK(FD) \
 	(FD_INRANGE(FD) && FD_ENTRY(FD))
 #define FD_OFFSET(FD) \
-	(this_core->current_process->fds->offsets[(FD)])
+	(FD_ENTRIES()[(FD)]->offset)
 #define FD_MODE(FD) \
-	(this_core->current_process->fds->modes[(FD)])
+	(FD_ENTRIES()[(FD)]->mode)
 
 #define PTR_INRANGE(PTR) \
 	((uintptr_t)(PTR) > this_core->current_process->image.entry && ((uintptr_t)(PTR) < 0x8000000000000000))
@@ -19,6 +23,34 @@
 	do { if (ptr_validate((void *)(PTR), __func__)) return -EINVAL; } while (0)
 extern int ptr_validate(void * ptr, const char * syscall);
 
+/**
+ * Copies between kernel and user memory. The range is checked
+ * against the process's VM areas (not its page tables) and then
+ * copied directly; a fault inside the copy is resolved by the page
+ * fault handler or, if the address is bad, redirected through the
+ * user_access_fixup table to return -EFAULT instead of killing the
+ * process. Every user mapping is registered as an area (see
+ * kernel/mmap.h), including ELF load segments, SHM and device maps.
+ *
+ * copy_from_user() and copy_to_user() return 0 on success and
+ * -EFAULT otherwise. strncpy_from_user() copies up to and including
+ * the first NUL within size bytes and returns the string's length
+ * without the NUL. If there is no NUL in the first size bytes, it
+ * copies size bytes, leaves dest unterminated and returns size. It
+ * returns -EFAULT if the source is not readable.
+ */
+extern int copy_from_user(void * dest, const void * src, size_t size);
+extern int copy_to_user(void * dest, const void * src, size_t size);
+extern long strncpy_from_user(char * dest, const char * src, size_t size);
+
+struct user_access_fixup {
+	uintptr_t ip;    /* Instruction in a user copy routine that may fault */
+	uintptr_t fixup; /* Where to resume if it does */
+};
+extern struct user_access_fixup __user_access_fixup_start[];
+extern struct user_access_fixup __user_access_fixup_end[];
+extern uintptr_t user_access_fixup(uintptr_t ip);
+
 extern long arch_syscall_number(struct regs * r);
 extern long arch_syscall_arg0(struct regs * r);
 extern long arch_syscall_arg1(struct regs * r);
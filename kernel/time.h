@@ -5,3 +5,16 @@
 extern void relative_time(unsigned long, unsigned long, unsigned long *, unsigned long *);
 extern uint64_t now(void);
 extern uint64_t arch_perf_timer(void);
+
+/**
+ * One-shot timer control for tickless idle.
+ *
+ * With the 'tickless' kernel argument, a core that is about to run its
+ * idle task stops its periodic tick and instead arms a one-shot
+ * deadline (LAPIC TSC-deadline or one-shot count on x86-64, the EL1
+ * physical timer on aarch64) for the earliest timed sleeper. Any
+ * interrupt that makes work ready restores the periodic tick.
+ */
+extern int timer_tickless;
+extern void arch_timer_oneshot(unsigned long seconds, unsigned long subseconds);
+extern void arch_timer_periodic(void);
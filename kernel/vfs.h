@@ -5,6 +5,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <bits/dirent.h>
+#include <sys/uio.h>
 
 #define PATH_SEPARATOR '/'
 #define PATH_SEPARATOR_STRING "/"
@@ -22,6 +23,9 @@
 #define FS_MOUNTPOINT  0x40
 #define FS_SOCKET      0x80
 
+#define FS_CACHEABLE   0x100 /* Reads and writes go through the page cache */
+#define FS_DCACHE      0x200 /* Lookups in this directory may be served from the dentry cache */
+
 #define _IFMT       0170000 /* type of file */
 #define     _IFDIR  0040000 /* directory */
 #define     _IFCHR  0020000 /* character special */
@@ -51,6 +55,8 @@ typedef int (*selectcheck_type_t) (struct fs_node *);
 typedef int (*selectwait_type_t) (struct fs_node *, void * process);
 typedef int (*chown_type_t) (struct fs_node *, uid_t, gid_t);
 typedef int (*truncate_type_t) (struct fs_node *);
+typedef ssize_t (*readv_type_t) (struct fs_node *, off_t, const struct iovec *, int);
+typedef ssize_t (*writev_type_t) (struct fs_node *, off_t, const struct iovec *, int);
 
 typedef struct fs_node {
 	char name[256];         /* The filename. */
@@ -94,6 +100,17 @@ typedef struct fs_node {
 	selectwait_type_t selectwait;
 
 	chown_type_t chown;
+
+	/**
+	 * Optional vectored I/O. readv_fs/writev_fs call these only for
+	 * nodes without FS_CACHEABLE; cacheable nodes move each segment
+	 * through pagecache_read/pagecache_write so cached pages and the
+	 * driver never diverge. Drivers without them get one read/write
+	 * call per segment. writev_fs invalidates the dentry cache exactly
+	 * as write_fs does (dcache_invalidate_node on FS_DCACHE nodes).
+	 */
+	readv_type_t readv;
+	writev_type_t writev;
 } fs_node_t;
 
 struct vfs_entry {
@@ -109,6 +126,8 @@ extern int pty_create(void *size, fs_node_t ** fs_master, fs_node_t ** fs_slave)
 int has_permission(fs_node_t *node, int permission_bit);
 ssize_t read_fs(fs_node_t *node,  off_t offset, size_t size, uint8_t *buffer);
 ssize_t write_fs(fs_node_t *node, off_t offset, size_t size, uint8_t *buffer);
+ssize_t readv_fs(fs_node_t *node, off_t offset, const struct iovec *iov, int iovcnt);
+ssize_t writev_fs(fs_node_t *node, off_t offset, const struct iovec *iov, int iovcnt);
 void open_fs(fs_node_t *node, unsigned int flags);
 void close_fs(fs_node_t *node);
 struct dirent *readdir_fs(fs_node_t *node, unsigned long index);
@@ -2,16 +2,22 @@
 
 #include <_cheader.h>
 #include <stdint.h>
+#include <time.h>
 
 _Begin_C_Header
 
 typedef struct __pthread * pthread_t;
 typedef unsigned int pthread_attr_t;
 
+/*
+ * Layout unchanged from the yield-spin implementation. Writers sleep
+ * in futex() on readers until it drops to zero; readers sleep on
+ * writerPid until the writer clears it.
+ */
 typedef struct {
 	int volatile atomic_lock;
 	int volatile readers;
-	int writerPid;
+	int volatile writerPid;
 } pthread_rwlock_t;
 
 extern int pthread_create(pthread_t * thread, pthread_attr_t * attr, void *(*start_routine)(void *), void * arg);
@@ -24,12 +30,25 @@ extern int gettid();
 extern void pthread_cleanup_push(void (*routine)(void *), void *arg);
 extern void pthread_cleanup_pop(int execute);
 
+/* 0: unlocked, 1: locked, 2: locked with sleepers waiting in futex() */
 typedef int volatile pthread_mutex_t;
 typedef int pthread_mutexattr_t;
 
+/*
+ * Waiters increment waiters before sleeping on seq; signal and
+ * broadcast bump seq and only call futex() when waiters is nonzero,
+ * so an uncontended signal stays in userspace.
+ */
+typedef struct {
+	int volatile seq;     /* futex word; bumped on every signal and broadcast */
+	int volatile waiters; /* threads in pthread_cond_wait/timedwait */
+} pthread_cond_t;
+typedef int pthread_condattr_t;
+
 extern int pthread_join(pthread_t thread, void **retval);
 
 #define PTHREAD_MUTEX_INITIALIZER 0
+#define PTHREAD_COND_INITIALIZER {0, 0}
 
 extern int pthread_mutex_lock(pthread_mutex_t *mutex);
 extern int pthread_mutex_trylock(pthread_mutex_t *mutex);
@@ -37,6 +56,13 @@ extern int pthread_mutex_unlock(pthread_mutex_t *mutex);
 extern int pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *attr);
 extern int pthread_mutex_destroy(pthread_mutex_t *mutex);
 
+extern int pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *attr);
+extern int pthread_cond_destroy(pthread_cond_t *cond);
+extern int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex);
+extern int pthread_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, const struct timespec *abstime);
+extern int pthread_cond_signal(pthread_cond_t *cond);
+extern int pthread_cond_broadcast(pthread_cond_t *cond);
+
 extern int pthread_attr_init(pthread_attr_t *attr);
 extern int pthread_attr_destroy(pthread_attr_t *attr);
 
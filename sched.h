@@ -1,7 +1,36 @@
 #pragma once
 
 #include <_cheader.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
 
 _Begin_C_Header
+
+#define SCHED_OTHER 0 /* Weighted fair share, adjusted by nice */
+#define SCHED_FIFO  1 /* Real-time, runs ahead of SCHED_OTHER until it blocks or yields */
+
+struct sched_param {
+	int sched_priority;
+};
+
+#define CPU_SETSIZE 64
+
+typedef struct {
+	uint64_t __bits;
+} cpu_set_t;
+
+#define CPU_ZERO(set)     ((set)->__bits = 0)
+#define CPU_SET(cpu, set) ((set)->__bits |= (1UL << (cpu)))
+#define CPU_CLR(cpu, set) ((set)->__bits &= ~(1UL << (cpu)))
+#define CPU_ISSET(cpu, set) (!!((set)->__bits & (1UL << (cpu))))
+#define CPU_COUNT(set)    __builtin_popcountl((set)->__bits)
+
 extern int sched_yield(void);
+extern int sched_setscheduler(pid_t pid, int policy, const struct sched_param * param);
+extern int sched_getscheduler(pid_t pid);
+extern int sched_get_priority_min(int policy);
+extern int sched_get_priority_max(int policy);
+extern int sched_setaffinity(pid_t pid, size_t cpusetsize, const cpu_set_t * mask);
+extern int sched_getaffinity(pid_t pid, size_t cpusetsize, cpu_set_t * mask);
 _End_C_Header
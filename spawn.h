@@ -0,0 +1,67 @@
+#pragma once
+
+#include <_cheader.h>
+#include <sys/types.h>
+#include <sys/signal.h>
+
+_Begin_C_Header
+
+/**
+ * File actions and attributes are passed to SYS_SPAWN as-is and
+ * applied by the kernel to the new process before it starts, so
+ * their layout is shared with the kernel.
+ */
+#define POSIX_SPAWN_ACTION_OPEN  1
+#define POSIX_SPAWN_ACTION_CLOSE 2
+#define POSIX_SPAWN_ACTION_DUP2  3
+
+struct __spawn_action {
+	int type;
+	int fd;
+	int newfd;
+	int oflag;
+	mode_t mode;
+	char * path;
+};
+
+typedef struct {
+	int count;
+	int capacity;
+	struct __spawn_action * actions;
+} posix_spawn_file_actions_t;
+
+#define POSIX_SPAWN_SETPGROUP  0x01
+#define POSIX_SPAWN_SETSIGMASK 0x02
+#define POSIX_SPAWN_SETSIGDEF  0x04
+#define POSIX_SPAWN_SETSID     0x08
+
+typedef struct {
+	short flags;
+	pid_t pgroup;
+	sigset_t sigmask;
+	sigset_t sigdefault;
+} posix_spawnattr_t;
+
+extern int posix_spawn(pid_t * pid, const char * path, const posix_spawn_file_actions_t * file_actions,
+	const posix_spawnattr_t * attrp, char * const argv[], char * const envp[]);
+extern int posix_spawnp(pid_t * pid, const char * file, const posix_spawn_file_actions_t * file_actions,
+	const posix_spawnattr_t * attrp, char * const argv[], char * const envp[]);
+
+extern int posix_spawn_file_actions_init(posix_spawn_file_actions_t * file_actions);
+extern int posix_spawn_file_actions_destroy(posix_spawn_file_actions_t * file_actions);
+extern int posix_spawn_file_actions_addopen(posix_spawn_file_actions_t * file_actions, int fd, const char * path, int oflag, mode_t mode);
+extern int posix_spawn_file_actions_addclose(posix_spawn_file_actions_t * file_actions, int fd);
+extern int posix_spawn_file_actions_adddup2(posix_spawn_file_actions_t * file_actions, int fd, int newfd);
+
+extern int posix_spawnattr_init(posix_spawnattr_t * attr);
+extern int posix_spawnattr_destroy(posix_spawnattr_t * attr);
+extern int posix_spawnattr_getflags(const posix_spawnattr_t * attr, short * flags);
+extern int posix_spawnattr_setflags(posix_spawnattr_t * attr, short flags);
+extern int posix_spawnattr_getpgroup(const posix_spawnattr_t * attr, pid_t * pgroup);
+extern int posix_spawnattr_setpgroup(posix_spawnattr_t * attr, pid_t pgroup);
+extern int posix_spawnattr_getsigmask(const posix_spawnattr_t * attr, sigset_t * sigmask);
+extern int posix_spawnattr_setsigmask(posix_spawnattr_t * attr, const sigset_t * sigmask);
+extern int posix_spawnattr_getsigdefault(const posix_spawnattr_t * attr, sigset_t * sigdefault);
+extern int posix_spawnattr_setsigdefault(posix_spawnattr_t * attr, const sigset_t * sigdefault);
+
+_End_C_Header
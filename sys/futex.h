@@ -0,0 +1,16 @@
+#pragma once
+
+#include <_cheader.h>
+
+_Begin_C_Header
+
+/**
+ * FUTEX_WAIT: sleep until woken, if *addr still equals val.
+ *             timeout is in milliseconds, as with fswait2; -1 waits forever.
+ * FUTEX_WAKE: wake up to val waiters sleeping on addr.
+ */
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+
+extern int futex(volatile int * addr, int op, int val, int timeout);
+_End_C_Header
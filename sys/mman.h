@@ -1,3 +1,37 @@
 #pragma once
 
-/* Nothing here, we don't have an mmap implementation yet? */
+#include <_cheader.h>
+#include <sys/types.h>
+
+_Begin_C_Header
+
+#define PROT_NONE  0x0
+#define PROT_READ  0x1
+#define PROT_WRITE 0x2
+#define PROT_EXEC  0x4
+
+#define MAP_SHARED    0x01
+#define MAP_PRIVATE   0x02
+#define MAP_FIXED     0x10
+#define MAP_ANONYMOUS 0x20
+#define MAP_ANON      MAP_ANONYMOUS
+
+#define MAP_FAILED ((void *)-1)
+
+#define MADV_NORMAL     0
+#define MADV_RANDOM     1
+#define MADV_SEQUENTIAL 2
+#define MADV_WILLNEED   3
+#define MADV_DONTNEED   4
+
+#define MS_ASYNC      1
+#define MS_INVALIDATE 2
+#define MS_SYNC       4
+
+extern void * mmap(void * addr, size_t length, int prot, int flags, int fd, off_t offset);
+extern int munmap(void * addr, size_t length);
+extern int mprotect(void * addr, size_t length, int prot);
+extern int madvise(void * addr, size_t length, int advice);
+extern int msync(void * addr, size_t length, int flags);
+
+_End_C_Header
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <_cheader.h>
+#include <sys/types.h>
+
+_Begin_C_Header
+
+#define PRIO_PROCESS 0
+#define PRIO_PGRP    1
+#define PRIO_USER    2
+
+/* Nice values run from PRIO_MIN to PRIO_MAX - 1, i.e. -20..19. */
+#define PRIO_MIN -20
+#define PRIO_MAX  20
+
+/* SYS_GETPRIORITY returns 20 - nice; getpriority() undoes the bias. */
+extern int getpriority(int which, id_t who);
+extern int setpriority(int which, id_t who, int prio);
+_End_C_Header
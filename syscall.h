@@ -234,6 +234,24 @@ DECL_SYSCALL2(setgroups, int, const int*);
 DECL_SYSCALL1(times, struct tms*);
 DECL_SYSCALL4(ptrace, int, int, void*, void*);
 DECL_SYSCALL2(settimeofday, void *, void *);
+DECL_SYSCALL4(futex, volatile int *, int, int, int);
+DECL_SYSCALL3(sched_setaffinity, int, size_t, const void *);
+DECL_SYSCALL3(sched_getaffinity, int, size_t, void *);
+DECL_SYSCALL2(getpriority, int, int); /* Returns 20 - nice (1..40) so it never looks like -errno */
+DECL_SYSCALL3(setpriority, int, int, int);
+DECL_SYSCALL3(sched_setscheduler, int, int, const void *);
+DECL_SYSCALL1(sched_getscheduler, int);
+DECL_SYSCALL5(spawn, const char *, char **, char **, const void *, const void *);
+DECL_SYSCALL0(vfork);
+DECL_SYSCALL5(mmap, void *, size_t, int, int, long); /* prot in the low byte of the third argument, flags above it */
+DECL_SYSCALL2(munmap, void *, size_t);
+DECL_SYSCALL3(mprotect, void *, size_t, int);
+DECL_SYSCALL3(madvise, void *, size_t, int);
+DECL_SYSCALL3(msync, void *, size_t, int);
+DECL_SYSCALL3(readv, int, const void *, int);
+DECL_SYSCALL3(writev, int, const void *, int);
+DECL_SYSCALL4(preadv, int, const void *, int, long);
+DECL_SYSCALL4(pwritev, int, const void *, int, long);
 
 _End_C_Header
 
@@ -82,3 +82,21 @@
 #define SYS_GETPEERNAME 79
 #define SYS_PREAD 80
 #define SYS_PWRITE 81
+#define SYS_FUTEX 82
+#define SYS_SCHED_SETAFFINITY 83
+#define SYS_SCHED_GETAFFINITY 84
+#define SYS_GETPRIORITY 85
+#define SYS_SETPRIORITY 86
+#define SYS_SCHED_SETSCHEDULER 87
+#define SYS_SCHED_GETSCHEDULER 88
+#define SYS_SPAWN 89
+#define SYS_VFORK 90
+#define SYS_MMAP 91
+#define SYS_MUNMAP 92
+#define SYS_MPROTECT 93
+#define SYS_MADVISE 94
+#define SYS_MSYNC 95
+#define SYS_READV 96
+#define SYS_WRITEV 97
+#define SYS_PREADV 98
+#define SYS_PWRITEV 99
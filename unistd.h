@@ -17,6 +17,7 @@ extern pid_t getppid(void);
 extern int close(int fd);
 
 extern pid_t fork(void);
+extern pid_t vfork(void);
 
 extern int execl(const char *path, const char *arg, ...);
 extern int execlp(const char *file, const char *arg, ...);
@@ -95,6 +96,7 @@ extern pid_t getpgid(pid_t);
 extern pid_t getpgrp(void);
 
 extern unsigned int alarm(unsigned int seconds);
+extern int nice(int inc);
 
 extern void *sbrk(intptr_t increment);
 